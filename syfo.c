@@ -1,9 +1,17 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/statvfs.h>
 #include <sys/sysinfo.h>
 #include <sys/types.h>
 #include <sys/utsname.h>
@@ -11,6 +19,10 @@
 #include <ctype.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 #include <GLFW/glfw3.h>
 
 #define MAX_LINE 1024
@@ -519,6 +531,610 @@ void getgpu(char* output) {
 //    glfwTerminate();
 //}
 
+// Sensors: the hwmon files are discovered once and kept open, so each
+// refresh costs a single pread() per sensor
+#define HWMON_DIR "/sys/class/hwmon"
+
+// "fan" and "power" only ever come from platform chips, the GPU's own
+// readings are kept apart so a field means the same thing on every host
+enum {
+  SENSOR_CPU_TEMP, SENSOR_GPU_TEMP, SENSOR_FAN, SENSOR_POWER,
+  SENSOR_GPU_FAN, SENSOR_GPU_POWER,
+  SENSOR_COUNT
+};
+
+static const char* sensor_names[SENSOR_COUNT] = {
+  "cpu temp", "gpu temp", "fan", "power", "gpu fan", "gpu power"
+};
+
+static int sensor_fds[SENSOR_COUNT];
+
+static int open_sensor(const char* dir, const char* file) {
+  char path[PATH_MAX];
+  if (snprintf(path, sizeof(path), "%s/%s", dir, file) >= (int)sizeof(path)) return -1;
+  return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+static int read_sensor_file(const char* dir, const char* file, char* buffer, size_t size) {
+  char path[PATH_MAX];
+  if (snprintf(path, sizeof(path), "%s/%s", dir, file) >= (int)sizeof(path)) return 0;
+  return read_file_fast(path, buffer, size);
+}
+
+// Package temperature: coretemp labels it "Package id N", k10temp "Tctl"
+static int open_cpu_temp(const char* dir) {
+  char file[32], label[64];
+  for (int i = 1; i < 32; i++) {
+    snprintf(file, sizeof(file), "temp%d_label", i);
+    if (!read_sensor_file(dir, file, label, sizeof(label))) continue;
+    if (!strncmp(label, "Package id", 10) || !strncmp(label, "Tctl", 4) || !strncmp(label, "Tdie", 4)) {
+      snprintf(file, sizeof(file), "temp%d_input", i);
+      return open_sensor(dir, file);
+    }
+  }
+  return open_sensor(dir, "temp1_input");
+}
+
+// With skip_idle, fan headers reading 0 RPM (usually nothing connected) are
+// passed over
+static int open_fan(const char* dir, int skip_idle) {
+  char file[32], buffer[32];
+  for (int i = 1; i < 8; i++) {
+    snprintf(file, sizeof(file), "fan%d_input", i);
+    int fd = open_sensor(dir, file);
+    if (fd == -1) continue;
+    if (skip_idle) {
+      ssize_t n = pread(fd, buffer, sizeof(buffer) - 1, 0);
+      if (n > 0) buffer[n] = '\0';
+      if (n <= 0 || strtol(buffer, NULL, 10) == 0) {
+        close(fd);
+        continue;
+      }
+    }
+    return fd;
+  }
+  return -1;
+}
+
+static int open_power(const char* dir) {
+  int fd = open_sensor(dir, "power1_average");
+  return fd != -1 ? fd : open_sensor(dir, "power1_input");
+}
+
+// Returns the number of sensors found
+static int sensors_open(void) {
+  static int opened = 0;
+  char path[512], dev[PATH_MAX], name[64];
+  struct dirent* entry;
+  struct dirent* hw;
+  DIR* dir;
+  int found = 0;
+
+  if (opened) {
+    for (int i = 0; i < SENSOR_COUNT; i++) found += sensor_fds[i] != -1;
+    return found;
+  }
+  opened = 1;
+  for (int i = 0; i < SENSOR_COUNT; i++) sensor_fds[i] = -1;
+
+  // GPU sensors hang off the same DRM devices getgpu() walks
+  if ((dir = opendir("/sys/class/drm")) != NULL) {
+    while ((entry = readdir(dir)) != NULL) {
+      if (strncmp(entry->d_name, "card", 4) != 0 || !isdigit(entry->d_name[4]) || strchr(entry->d_name, '-'))
+        continue;
+      snprintf(path, sizeof(path), "/sys/class/drm/%s/device/hwmon", entry->d_name);
+      DIR* hwdir = opendir(path);
+      if (!hwdir) continue;
+      while ((hw = readdir(hwdir)) != NULL) {
+        if (strncmp(hw->d_name, "hwmon", 5) != 0) continue;
+        snprintf(dev, sizeof(dev), "%s/%s", path, hw->d_name);
+        if (sensor_fds[SENSOR_GPU_TEMP] == -1) sensor_fds[SENSOR_GPU_TEMP] = open_sensor(dev, "temp1_input");
+        if (sensor_fds[SENSOR_GPU_FAN] == -1) sensor_fds[SENSOR_GPU_FAN] = open_fan(dev, 0);
+        if (sensor_fds[SENSOR_GPU_POWER] == -1) sensor_fds[SENSOR_GPU_POWER] = open_power(dev);
+      }
+      closedir(hwdir);
+    }
+    closedir(dir);
+  }
+
+  // CPU temperature, fan and power from the platform chips. GPUs show up
+  // here too; skip them, they were handled above
+  if ((dir = opendir(HWMON_DIR)) != NULL) {
+    while ((entry = readdir(dir)) != NULL) {
+      if (strncmp(entry->d_name, "hwmon", 5) != 0) continue;
+      snprintf(dev, sizeof(dev), HWMON_DIR "/%s", entry->d_name);
+      snprintf(path, sizeof(path), HWMON_DIR "/%s/device/drm", entry->d_name);
+      if (access(path, F_OK) == 0) continue;
+      if (!read_sensor_file(dev, "name", name, sizeof(name))) continue;
+      trim(name);
+
+      if (sensor_fds[SENSOR_CPU_TEMP] == -1 &&
+          (!strcmp(name, "coretemp") || !strcmp(name, "k10temp") ||
+           !strcmp(name, "zenpower") || !strcmp(name, "cpu_thermal")))
+        sensor_fds[SENSOR_CPU_TEMP] = open_cpu_temp(dev);
+      if (sensor_fds[SENSOR_FAN] == -1) sensor_fds[SENSOR_FAN] = open_fan(dev, 1);
+      if (sensor_fds[SENSOR_POWER] == -1) sensor_fds[SENSOR_POWER] = open_power(dev);
+    }
+    closedir(dir);
+  }
+
+  for (int i = 0; i < SENSOR_COUNT; i++) found += sensor_fds[i] != -1;
+  return found;
+}
+
+// Get sensor readings; unavailable sensors are left empty
+void getsensors(char output[SENSOR_COUNT][MAX_OUTPUT]) {
+  char buffer[32];
+
+  sensors_open();
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    output[i][0] = '\0';
+    if (sensor_fds[i] == -1) continue;
+
+    ssize_t n = pread(sensor_fds[i], buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) continue;
+    buffer[n] = '\0';
+    long value = strtol(buffer, NULL, 10);
+
+    switch (i) {
+      case SENSOR_CPU_TEMP:
+      case SENSOR_GPU_TEMP: // millidegrees
+        snprintf(output[i], MAX_OUTPUT, "%ld C", value / 1000);
+        break;
+      case SENSOR_FAN:
+      case SENSOR_GPU_FAN:
+        snprintf(output[i], MAX_OUTPUT, "%ld RPM", value);
+        break;
+      case SENSOR_POWER:
+      case SENSOR_GPU_POWER: // microwatts
+        snprintf(output[i], MAX_OUTPUT, "%.1f W", value / 1e6);
+        break;
+    }
+  }
+}
+
+// Disk usage: statvfs() runs on worker threads against a deadline, so a dead
+// NFS/CIFS/FUSE mount is reported as unavailable instead of hanging syfo
+#define MOUNTINFO "/proc/self/mountinfo"
+#define MAX_DISKS 8
+#define DISK_TIMEOUT_MS 500
+
+struct disk {
+  char mount[PATH_MAX];
+  int exact;
+  int done;
+  int ok;
+  unsigned long long total;
+  unsigned long long used;
+};
+
+// Static because a worker stuck on a dead mount may outlive getdisks()
+static struct disk disks[MAX_DISKS];
+static pthread_mutex_t disk_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t disk_cond;
+static pthread_once_t disk_once = PTHREAD_ONCE_INIT;
+
+// Wait on the monotonic clock so an NTP step can't stretch the deadline
+static void disk_init(void) {
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&disk_cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+static void* disk_worker(void* arg) {
+  struct disk* d = arg;
+  struct statvfs sv;
+  int ok = statvfs(d->mount, &sv) == 0;
+
+  pthread_mutex_lock(&disk_lock);
+  if (ok) {
+    d->total = (unsigned long long)sv.f_blocks * sv.f_frsize;
+    d->used = (unsigned long long)(sv.f_blocks - sv.f_bfree) * sv.f_frsize;
+  }
+  d->ok = ok;
+  d->done = 1;
+  pthread_cond_signal(&disk_cond);
+  pthread_mutex_unlock(&disk_lock);
+  return NULL;
+}
+
+// mountinfo escapes whitespace and backslashes as \ooo
+static void unescape_mount(char* str) {
+  char* out = str;
+  for (char* p = str; *p; p++) {
+    if (p[0] == '\\' && p[1] >= '0' && p[1] <= '7' && p[2] >= '0' && p[2] <= '7' && p[3] >= '0' && p[3] <= '7') {
+      *out++ = (char)((p[1] - '0') * 64 + (p[2] - '0') * 8 + (p[3] - '0'));
+      p += 3;
+    } else {
+      *out++ = *p;
+    }
+  }
+  *out = '\0';
+}
+
+// Resolve each target to the mount point holding it in a single pass over
+// mountinfo: the longest matching mount point wins, and a later entry on the
+// same directory shadows an earlier one. Autofs triggers are skipped, since
+// statvfs() on them would start a mount. Targets marked exact must be mount
+// points themselves; unresolved targets are cleared.
+static void resolve_mounts(struct disk* targets, int count) {
+  char line[MAX_LINE * 4];
+  size_t best[MAX_DISKS] = {0};
+  char found[MAX_DISKS][PATH_MAX];
+  FILE* fp = fopen(MOUNTINFO, "r");
+
+  for (int i = 0; i < count; i++) found[i][0] = '\0';
+  if (fp) {
+    while (fgets(line, sizeof(line), fp)) {
+      char* sep = strstr(line, " - ");
+      char* mount = line;
+      if (!sep) continue;
+      if (!strncmp(sep + 3, "autofs ", 7)) continue;
+
+      // Mount point is the fifth field
+      for (int f = 0; f < 4 && mount; f++) {
+        mount = strchr(mount, ' ');
+        if (mount) mount++;
+      }
+      if (!mount) continue;
+      mount[strcspn(mount, " ")] = '\0';
+      unescape_mount(mount);
+      size_t len = strlen(mount);
+
+      for (int i = 0; i < count; i++) {
+        const char* target = targets[i].mount;
+        int match;
+        if (targets[i].exact)
+          match = !strcmp(target, mount);
+        else
+          match = !strncmp(target, mount, len) && (len == 1 || target[len] == '/' || target[len] == '\0');
+        if (match && len >= best[i]) {
+          best[i] = len;
+          snprintf(found[i], PATH_MAX, "%s", mount);
+        }
+      }
+    }
+    fclose(fp);
+  }
+
+  for (int i = 0; i < count; i++) {
+    memcpy(targets[i].mount, found[i], PATH_MAX);
+  }
+}
+
+// Copy a mount point into a MAX_OUTPUT label, keeping its tail behind "..."
+// when it is too long to fit
+static void mount_label(char* output, const char* mount) {
+  size_t len = strlen(mount);
+  if (len < MAX_OUTPUT) {
+    memcpy(output, mount, len + 1);
+  } else {
+    memcpy(output, "...", 3);
+    memcpy(output + 3, mount + len - (MAX_OUTPUT - 4), MAX_OUTPUT - 3);
+  }
+}
+
+static void human_size(unsigned long long bytes, char* output, size_t size) {
+  const char* units = "BKMGTP";
+  double value = bytes;
+  int unit = 0;
+  while (value >= 1024 && unit < 5) {
+    value /= 1024;
+    unit++;
+  }
+  snprintf(output, size, unit ? "%.1f%c" : "%.0f%c", value, units[unit]);
+}
+
+// Get disk usage for /, the mount holding $HOME (when it is not /) and any
+// mount points listed in $SYFO_MOUNTS, separated by colons. Slot 0 is always
+// /, slot 1 the home mount; empty slots have an empty mount and usage. Only
+// the first MAX_DISKS - 2 entries of $SYFO_MOUNTS are used, with a warning
+// on stderr about the rest.
+int getdisks(char mounts[MAX_DISKS][MAX_OUTPUT], char output[MAX_DISKS][MAX_OUTPUT]) {
+  struct disk targets[MAX_DISKS];
+  int count = 0;
+  char* home = getenv("HOME");
+  char* extra = getenv("SYFO_MOUNTS");
+
+  pthread_once(&disk_once, disk_init);
+  memset(targets, 0, sizeof(targets));
+  strcpy(targets[count].mount, "/");
+  targets[count++].exact = 1;
+  snprintf(targets[count++].mount, PATH_MAX, "%s", home && home[0] == '/' ? home : "/");
+
+  if (extra) {
+    char list[MAX_LINE];
+    char* save;
+    snprintf(list, sizeof(list), "%s", extra);
+    for (char* m = strtok_r(list, ":", &save); m; m = strtok_r(NULL, ":", &save)) {
+      if (count == MAX_DISKS) {
+        fprintf(stderr, "syfo: SYFO_MOUNTS: ignoring %s and later entries (at most %d)\n", m, MAX_DISKS - 2);
+        break;
+      }
+      snprintf(targets[count].mount, PATH_MAX, "%s", m);
+      targets[count++].exact = 1;
+    }
+  }
+
+  char requested[MAX_DISKS][MAX_OUTPUT];
+  for (int i = 0; i < count; i++) mount_label(requested[i], targets[i].mount);
+  resolve_mounts(targets, count);
+
+  int missing[MAX_DISKS];
+  for (int i = 0; i < count; i++) missing[i] = targets[i].mount[0] == '\0';
+
+  // Drop mounts already covered by an earlier slot
+  for (int i = 1; i < count; i++) {
+    if (targets[i].mount[0] == '\0') continue;
+    for (int j = 0; j < i; j++) {
+      if (!strcmp(targets[i].mount, targets[j].mount)) targets[i].mount[0] = '\0';
+    }
+  }
+
+  // Hand the targets to workers; a stuck worker keeps its slot forever, so
+  // never reuse one that has not finished
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  int slot[MAX_DISKS];
+  pthread_mutex_lock(&disk_lock);
+  for (int i = 0; i < count; i++) {
+    slot[i] = -1;
+    if (targets[i].mount[0] == '\0') continue;
+    for (int j = 0; j < MAX_DISKS; j++) {
+      if (disks[j].mount[0] == '\0' || disks[j].done) {
+        disks[j] = targets[i];
+        slot[i] = j;
+        break;
+      }
+    }
+  }
+  pthread_mutex_unlock(&disk_lock);
+
+  for (int i = 0; i < count; i++) {
+    pthread_t thread;
+    if (slot[i] == -1) continue;
+    if (pthread_create(&thread, &attr, disk_worker, &disks[slot[i]]) != 0) {
+      pthread_mutex_lock(&disk_lock);
+      disks[slot[i]].done = 1;
+      pthread_mutex_unlock(&disk_lock);
+    }
+  }
+  pthread_attr_destroy(&attr);
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_nsec += DISK_TIMEOUT_MS * 1000000L;
+  deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+  deadline.tv_nsec %= 1000000000L;
+
+  pthread_mutex_lock(&disk_lock);
+  for (;;) {
+    int pending = 0;
+    for (int i = 0; i < count; i++) {
+      if (slot[i] != -1 && !disks[slot[i]].done) pending++;
+    }
+    if (pending == 0 || pthread_cond_timedwait(&disk_cond, &disk_lock, &deadline) == ETIMEDOUT)
+      break;
+  }
+
+  for (int i = 0; i < count; i++) {
+    mounts[i][0] = output[i][0] = '\0';
+    if (targets[i].mount[0] == '\0') {
+      if (missing[i]) {
+        strcpy(mounts[i], requested[i]);
+        strcpy(output[i], "not mounted");
+      }
+      continue;
+    }
+    mount_label(mounts[i], targets[i].mount);
+
+    struct disk* d = slot[i] != -1 ? &disks[slot[i]] : NULL;
+    if (!d || !d->done || !d->ok) {
+      strcpy(output[i], "unavailable");
+    } else {
+      char used[32], total[32];
+      human_size(d->used, used, sizeof(used));
+      human_size(d->total, total, sizeof(total));
+      snprintf(output[i], MAX_OUTPUT, "%s / %s (%llu%%)", used, total,
+               d->total ? d->used * 100 / d->total : 0);
+    }
+  }
+  pthread_mutex_unlock(&disk_lock);
+  return count;
+}
+
+// Network: one RTM_GETLINK and one RTM_GETADDR dump over a single netlink
+// socket, parsed in place in the receive buffer
+enum { NET_IFACE, NET_IPV4, NET_IPV6, NET_COUNT };
+
+static const char* net_names[NET_COUNT] = {
+  "network", "ipv4", "ipv6"
+};
+
+// Indexed by IF_OPER_*
+static const char* net_states[] = {
+  "unknown", "notpresent", "down", "lowerlayerdown", "testing", "dormant", "up"
+};
+
+struct net_link {
+  int index;
+  unsigned int flags;
+  unsigned char operstate;
+  char name[IFNAMSIZ];
+  char ipv4[128];
+  char ipv6[128];
+};
+
+struct net_links {
+  struct net_link* links;
+  int count;
+  int cap;
+};
+
+static struct net_link* net_find(struct net_links* l, int index) {
+  for (int i = 0; i < l->count; i++) {
+    if (l->links[i].index == index) return &l->links[i];
+  }
+  return NULL;
+}
+
+static void net_append(char* list, size_t size, const char* addr) {
+  size_t len = strlen(list);
+  if (size - len > strlen(addr) + 2) snprintf(list + len, size - len, "%s%s", len ? ", " : "", addr);
+}
+
+static void net_parse(struct net_links* l, struct nlmsghdr* nh) {
+  if (nh->nlmsg_type == RTM_NEWLINK) {
+    struct ifinfomsg* ifi = NLMSG_DATA(nh);
+    int len = IFLA_PAYLOAD(nh);
+
+    if (l->count == l->cap) {
+      struct net_link* links = realloc(l->links, (l->cap ? l->cap * 2 : 64) * sizeof(*links));
+      if (!links) return;
+      l->links = links;
+      l->cap = l->cap ? l->cap * 2 : 64;
+    }
+    struct net_link* link = &l->links[l->count++];
+    memset(link, 0, sizeof(*link));
+    link->index = ifi->ifi_index;
+    link->flags = ifi->ifi_flags;
+
+    for (struct rtattr* rta = IFLA_RTA(ifi); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+      if (rta->rta_type == IFLA_IFNAME) {
+        snprintf(link->name, sizeof(link->name), "%.*s", (int)RTA_PAYLOAD(rta), (char*)RTA_DATA(rta));
+      } else if (rta->rta_type == IFLA_OPERSTATE) {
+        link->operstate = *(unsigned char*)RTA_DATA(rta);
+      }
+    }
+  }
+
+  else if (nh->nlmsg_type == RTM_NEWADDR) {
+    struct ifaddrmsg* ifa = NLMSG_DATA(nh);
+    int len = IFA_PAYLOAD(nh);
+    struct net_link* link = net_find(l, ifa->ifa_index);
+    void* local = NULL;
+    void* address = NULL;
+
+    // Link-local addresses say nothing about how the host is reached
+    if (!link || ifa->ifa_scope == RT_SCOPE_LINK) return;
+    if (ifa->ifa_family != AF_INET && ifa->ifa_family != AF_INET6) return;
+
+    for (struct rtattr* rta = IFA_RTA(ifa); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+      if (rta->rta_type == IFA_LOCAL) local = RTA_DATA(rta);
+      else if (rta->rta_type == IFA_ADDRESS) address = RTA_DATA(rta);
+    }
+    // On point-to-point links IFA_ADDRESS is the peer
+    if (local) address = local;
+    if (!address) return;
+
+    char addr[INET6_ADDRSTRLEN + 8];
+    if (!inet_ntop(ifa->ifa_family, address, addr, INET6_ADDRSTRLEN)) return;
+    snprintf(addr + strlen(addr), 8, "/%u", ifa->ifa_prefixlen);
+
+    if (ifa->ifa_family == AF_INET)
+      net_append(link->ipv4, sizeof(link->ipv4), addr);
+    else
+      net_append(link->ipv6, sizeof(link->ipv6), addr);
+  }
+}
+
+static int net_dump(int fd, int type, struct net_links* l) {
+  static unsigned int seq = 0;
+  static long buffer[8192];
+  struct {
+    struct nlmsghdr nh;
+    union {
+      struct ifinfomsg ifi;
+      struct ifaddrmsg ifa;
+    } u;
+  } req;
+
+  memset(&req, 0, sizeof(req));
+  req.nh.nlmsg_len = NLMSG_LENGTH(type == RTM_GETLINK ? sizeof(req.u.ifi) : sizeof(req.u.ifa));
+  req.nh.nlmsg_type = type;
+  req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.nh.nlmsg_seq = ++seq;
+  if (send(fd, &req, req.nh.nlmsg_len, 0) == -1) return 0;
+
+  for (;;) {
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n == -1 && errno == EINTR) continue;
+    if (n <= 0) return 0;
+
+    int len = n;
+    for (struct nlmsghdr* nh = (struct nlmsghdr*)buffer; NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+      if (nh->nlmsg_seq != seq) continue;
+      if (nh->nlmsg_type == NLMSG_DONE) return 1;
+      if (nh->nlmsg_type == NLMSG_ERROR) return 0;
+      net_parse(l, nh);
+    }
+  }
+}
+
+// Get the primary interface: the first one that is up, not loopback and has
+// an IPv4 address, then one with only IPv6, then loopback. Links with
+// carrier are tried before those without.
+void getnet(char output[NET_COUNT][MAX_OUTPUT]) {
+  struct net_links l = { NULL, 0, 0 };
+  struct net_link* primary = NULL;
+
+  for (int i = 0; i < NET_COUNT; i++) output[i][0] = '\0';
+
+  int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (fd == -1) {
+    strcpy(output[NET_IFACE], "unknown");
+    return;
+  }
+  if (!net_dump(fd, RTM_GETLINK, &l) || !net_dump(fd, RTM_GETADDR, &l)) {
+    close(fd);
+    free(l.links);
+    strcpy(output[NET_IFACE], "unknown");
+    return;
+  }
+  close(fd);
+
+  // Links with carrier (IFF_RUNNING: operstate up, or unknown as on lo) win
+  // over ones that are only administratively up, like an idle docker0;
+  // loopback is the last resort either way
+  for (int pass = 0; pass < 5 && !primary; pass++) {
+    for (int i = 0; i < l.count && !primary; i++) {
+      struct net_link* link = &l.links[i];
+      int loopback = link->flags & IFF_LOOPBACK;
+      if (!(link->flags & IFF_UP)) continue;
+      if (pass < 2 && !(link->flags & IFF_RUNNING)) continue;
+      if (((pass == 0 || pass == 2) && !loopback && link->ipv4[0]) ||
+          ((pass == 1 || pass == 3) && !loopback && link->ipv6[0]) ||
+          (pass == 4 && loopback))
+        primary = link;
+    }
+  }
+
+  if (!primary) {
+    strcpy(output[NET_IFACE], "unknown");
+    free(l.links);
+    return;
+  }
+
+  // Link speed is not part of rtnetlink; read it for the primary link only
+  char path[64], speed[32] = "";
+  snprintf(path, sizeof(path), "/sys/class/net/%s/speed", primary->name);
+  if (read_file_fast(path, speed, sizeof(speed)) && atoi(speed) > 0)
+    snprintf(speed, sizeof(speed), ", %d Mb/s", atoi(speed));
+  else
+    speed[0] = '\0';
+
+  const char* state = primary->operstate < sizeof(net_states) / sizeof(net_states[0])
+                      ? net_states[primary->operstate] : "unknown";
+  snprintf(output[NET_IFACE], MAX_OUTPUT, "%s (%s%s)", primary->name, state, speed);
+  strcpy(output[NET_IPV4], primary->ipv4);
+  strcpy(output[NET_IPV6], primary->ipv6);
+  free(l.links);
+}
+
 // Get hostname
 void gethostname_wrapper(char* output) {
   if (gethostname(output, MAX_OUTPUT) != 0) {
@@ -526,6 +1142,361 @@ void gethostname_wrapper(char* output) {
   }
 }
 
+// Snapshot log (--record / --history)
+//
+// The file starts with SNAP_MAGIC, followed by records. Each record is a
+// fixed-size snap_hdr and `len` payload bytes: `nstrings` new strings
+// (u16 length + bytes) appended to the interned string table, then
+// `nfields` (u8 field id, u16 string id) pairs for the fields that changed
+// since the previous record. A keyframe carries every field and resets the
+// string table, so each one starts a self-contained segment that can be
+// decoded without reading anything before it.
+#define SNAP_MAGIC "SYFOLOG1"
+#define SNAP_MAGIC_LEN 8
+#define SNAP_KEYFRAME 64
+#define SNAP_FLAG_KEYFRAME 1
+#define SNAP_MAX_FIELDS 256
+#define SNAP_MAX_STRINGS (SNAP_KEYFRAME * SNAP_MAX_FIELDS)
+
+// Field ids are stored on disk: only ever append to this list
+enum {
+  SNAP_DISTRO, SNAP_KERNEL, SNAP_UPTIME, SNAP_PKGS, SNAP_WM, SNAP_TERM,
+  SNAP_SHELL, SNAP_CPU, SNAP_GPU, SNAP_HOSTNAME,
+  SNAP_CPU_TEMP, SNAP_GPU_TEMP, SNAP_FAN, SNAP_POWER,
+  SNAP_DISK_ROOT, SNAP_DISK_HOME,
+  SNAP_NET_IFACE, SNAP_NET_IPV4, SNAP_NET_IPV6,
+  SNAP_GPU_FAN, SNAP_GPU_POWER,
+  SNAP_FIELDS
+};
+
+static const char* snap_names[SNAP_FIELDS] = {
+  "distro", "kernel", "uptime", "packages", "wm", "terminal",
+  "shell", "cpu", "gpu", "hostname",
+  "cpu temp", "gpu temp", "fan", "power",
+  "disk /", "disk home",
+  "network", "ipv4", "ipv6",
+  "gpu fan", "gpu power"
+};
+
+struct snap_hdr {
+  int64_t time;
+  uint32_t len;
+  uint8_t flags;
+  uint8_t nfields;
+  uint16_t nstrings;
+};
+
+struct snap_str {
+  const char* s;
+  uint16_t len;
+};
+
+struct snap_state {
+  struct snap_str strs[SNAP_MAX_STRINGS];
+  int nstrs;
+  int field[SNAP_MAX_FIELDS];
+  int count;
+};
+
+static void snap_reset(struct snap_state* st) {
+  st->nstrs = 0;
+  st->count = SNAP_KEYFRAME;
+  for (int i = 0; i < SNAP_MAX_FIELDS; i++) st->field[i] = -1;
+}
+
+// Read the header at `off`; returns the offset of the next record, or 0 if
+// there is no complete record there
+static size_t snap_next(const unsigned char* map, size_t size, size_t off, struct snap_hdr* h) {
+  if (size - off < sizeof(*h)) return 0;
+  memcpy(h, map + off, sizeof(*h));
+  if (size - off - sizeof(*h) < h->len) return 0;
+  return off + sizeof(*h) + h->len;
+}
+
+// Decode one record into the state; returns 0, leaving the state untouched,
+// if the payload is malformed
+static int snap_apply(struct snap_state* st, const struct snap_hdr* h, const unsigned char* payload) {
+  const unsigned char* end = payload + h->len;
+  const unsigned char* p = payload;
+  int keyframe = h->flags & SNAP_FLAG_KEYFRAME;
+  int nstrs = (keyframe ? 0 : st->nstrs) + h->nstrings;
+  uint16_t v;
+
+  // Validate everything first so a bad record can't leave half its strings
+  // and fields behind
+  if (nstrs > SNAP_MAX_STRINGS) return 0;
+  for (int i = 0; i < h->nstrings; i++) {
+    if (end - p < 2) return 0;
+    memcpy(&v, p, 2);
+    p += 2;
+    if (end - p < v) return 0;
+    p += v;
+  }
+  if (end - p < h->nfields * 3) return 0;
+  for (int i = 0; i < h->nfields; i++) {
+    memcpy(&v, p + i * 3 + 1, 2);
+    if (v >= nstrs) return 0;
+  }
+
+  if (keyframe) {
+    snap_reset(st);
+    st->count = 0;
+  }
+
+  p = payload;
+  for (int i = 0; i < h->nstrings; i++) {
+    memcpy(&v, p, 2);
+    st->strs[st->nstrs].s = (const char*)p + 2;
+    st->strs[st->nstrs].len = v;
+    st->nstrs++;
+    p += 2 + v;
+  }
+
+  for (int i = 0; i < h->nfields; i++) {
+    memcpy(&v, p + 1, 2);
+    st->field[p[0]] = v;
+    p += 3;
+  }
+
+  st->count++;
+  return 1;
+}
+
+// Map a log read-only; returns 0 on error. An empty file maps to NULL.
+static int snap_map(const char* path, int fd, unsigned char** map, size_t* size) {
+  struct stat sb;
+
+  *map = NULL;
+  *size = 0;
+  if (fstat(fd, &sb) == -1) {
+    perror(path);
+    return 0;
+  }
+  if (sb.st_size == 0) return 1;
+
+  *map = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (*map == MAP_FAILED) {
+    *map = NULL;
+    perror(path);
+    return 0;
+  }
+  *size = sb.st_size;
+  if (*size < SNAP_MAGIC_LEN || memcmp(*map, SNAP_MAGIC, SNAP_MAGIC_LEN) != 0) {
+    fprintf(stderr, "%s: not a syfo log\n", path);
+    munmap(*map, *size);
+    *map = NULL;
+    return 0;
+  }
+  return 1;
+}
+
+// Append the collected fields to the log at `path`
+int snap_record(const char* path, const char* values[SNAP_FIELDS]) {
+  static struct snap_state st;
+  struct snap_hdr h;
+  size_t size = 0, off = SNAP_MAGIC_LEN, next, key = 0;
+
+  int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (fd == -1) {
+    perror(path);
+    return 1;
+  }
+  flock(fd, LOCK_EX);
+
+  snap_reset(&st);
+  unsigned char* map;
+  if (!snap_map(path, fd, &map, &size)) {
+    close(fd);
+    return 1;
+  }
+
+  if (map == NULL) {
+    if (write(fd, SNAP_MAGIC, SNAP_MAGIC_LEN) != SNAP_MAGIC_LEN) {
+      perror(path);
+      close(fd);
+      return 1;
+    }
+  } else {
+    // Hop over headers to the last keyframe, then replay only its segment
+    while ((next = snap_next(map, size, off, &h))) {
+      if (h.flags & SNAP_FLAG_KEYFRAME) key = off;
+      off = next;
+    }
+    // Drop the torn tail of an interrupted write, and start a fresh segment
+    // rather than build on what was cut off
+    if (off < size) {
+      if (ftruncate(fd, off) == -1) perror(path);
+      st.count = SNAP_KEYFRAME;
+    }
+    // A complete record that fails to decode is left in place; the new
+    // keyframe lets --history pick up again after it
+    if (key) {
+      for (size_t at = key; (next = snap_next(map, size, at, &h)); at = next) {
+        if (!snap_apply(&st, &h, map + at + sizeof(h))) {
+          fprintf(stderr, "%s: corrupt record at offset %zu, starting a new keyframe\n", path, at);
+          st.count = SNAP_KEYFRAME;
+          break;
+        }
+      }
+    }
+  }
+
+  int keyframe = st.count >= SNAP_KEYFRAME || st.nstrs + SNAP_FIELDS > SNAP_MAX_STRINGS;
+  if (keyframe) st.nstrs = 0;
+
+  unsigned char rec[sizeof(h) + SNAP_FIELDS * (2 + MAX_OUTPUT + 3)];
+  unsigned char fields[SNAP_FIELDS * 3];
+  unsigned char* p = rec + sizeof(h);
+  int nfields = 0, nstrings = 0;
+
+  for (int i = 0; i < SNAP_FIELDS; i++) {
+    uint16_t len = strnlen(values[i], MAX_OUTPUT);
+    int id = st.field[i];
+
+    if (!keyframe && id >= 0 && st.strs[id].len == len && memcmp(st.strs[id].s, values[i], len) == 0)
+      continue;
+
+    // Intern: reuse an earlier string from this segment if there is one
+    for (id = 0; id < st.nstrs; id++) {
+      if (st.strs[id].len == len && memcmp(st.strs[id].s, values[i], len) == 0) break;
+    }
+    if (id == st.nstrs) {
+      st.strs[st.nstrs].s = values[i];
+      st.strs[st.nstrs].len = len;
+      st.nstrs++;
+      memcpy(p, &len, 2);
+      memcpy(p + 2, values[i], len);
+      p += 2 + len;
+      nstrings++;
+    }
+
+    uint16_t v = id;
+    fields[nfields * 3] = i;
+    memcpy(fields + nfields * 3 + 1, &v, 2);
+    nfields++;
+  }
+  memcpy(p, fields, nfields * 3);
+  p += nfields * 3;
+
+  h.time = time(NULL);
+  h.len = p - rec - sizeof(h);
+  h.flags = keyframe ? SNAP_FLAG_KEYFRAME : 0;
+  h.nfields = nfields;
+  h.nstrings = nstrings;
+  memcpy(rec, &h, sizeof(h));
+
+  int ret = 0;
+  if (write(fd, rec, p - rec) != p - rec) {
+    perror(path);
+    ret = 1;
+  }
+  if (map) munmap(map, size);
+  close(fd);
+  return ret;
+}
+
+static void snap_print_field(int id, const struct snap_str* from, const struct snap_str* to) {
+  char label[32];
+  if (id < SNAP_FIELDS)
+    snprintf(label, sizeof(label), "%s:", snap_names[id]);
+  else
+    snprintf(label, sizeof(label), "field%d:", id);
+
+  if (from)
+    printf("  %-13s %.*s -> %.*s\n", label, from->len, from->s, to->len, to->s);
+  else
+    printf("  %-13s %.*s\n", label, to->len, to->s);
+}
+
+// Print the state at the first record at or after `since`, then every
+// change up to `until`
+int snap_history(const char* path, int64_t since, int64_t until) {
+  static struct snap_state st;
+  static struct snap_str shown[SNAP_MAX_FIELDS];
+  struct snap_hdr h;
+  unsigned char* map;
+  size_t size, off, next;
+
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    perror(path);
+    return 1;
+  }
+  int ok = snap_map(path, fd, &map, &size);
+  close(fd);
+  if (map == NULL) return !ok;
+
+  // Sparse index: one (time, offset) entry per keyframe
+  struct { int64_t time; size_t off; } *index = NULL;
+  size_t n = 0, cap = 0;
+  for (off = SNAP_MAGIC_LEN; (next = snap_next(map, size, off, &h)); off = next) {
+    if (!(h.flags & SNAP_FLAG_KEYFRAME)) continue;
+    if (n == cap) {
+      void* grown = realloc(index, (cap ? cap * 2 : 64) * sizeof(*index));
+      if (!grown) {
+        perror(path);
+        free(index);
+        munmap(map, size);
+        return 1;
+      }
+      index = grown;
+      cap = cap ? cap * 2 : 64;
+    }
+    index[n].time = h.time;
+    index[n].off = off;
+    n++;
+  }
+
+  // Start from the last keyframe at or before `since`
+  size_t lo = 0, hi = n;
+  while (hi - lo > 1) {
+    size_t mid = (lo + hi) / 2;
+    if (index[mid].time <= since) lo = mid;
+    else hi = mid;
+  }
+
+  snap_reset(&st);
+  memset(shown, 0, sizeof(shown));
+  int printed = 0, ret = 0;
+
+  for (off = n ? index[lo].off : size; (next = snap_next(map, size, off, &h)); off = next) {
+    if (h.time > until) break;
+    if (!snap_apply(&st, &h, map + off + sizeof(h))) {
+      // Skip the rest of the segment and resume at the next keyframe
+      fprintf(stderr, "%s: corrupt record at offset %zu\n", path, off);
+      ret = 1;
+      while (lo < n && index[lo].off <= off) lo++;
+      if (lo == n) break;
+      next = index[lo].off;
+      continue;
+    }
+
+    int header = 0;
+    for (int i = 0; i < SNAP_MAX_FIELDS; i++) {
+      if (st.field[i] < 0) continue;
+      const struct snap_str* cur = &st.strs[st.field[i]];
+      int changed = shown[i].len != cur->len || (cur->len && memcmp(shown[i].s, cur->s, cur->len) != 0);
+
+      if (h.time >= since && (changed || (!printed && cur->len))) {
+        if (!header) {
+          char stamp[32];
+          time_t t = h.time;
+          strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", localtime(&t));
+          printf("%s\n", stamp);
+          header = 1;
+        }
+        snap_print_field(i, printed && shown[i].len ? &shown[i] : NULL, cur);
+      }
+      shown[i] = *cur;
+    }
+    if (header) printed = 1;
+  }
+
+  free(index);
+  munmap(map, size);
+  return ret;
+}
+
 // Calculate string length for display (without color codes)
 size_t display_len(const char* str) {
   size_t len = 0;
@@ -543,6 +1514,31 @@ size_t display_len(const char* str) {
   return len;
 }
 
+#define MAX_EXTRA (SENSOR_COUNT + MAX_DISKS + NET_COUNT)
+
+// Add a field to the box printed below the main one, if it has a value
+void add_extra(char extra[][MAX_LINE], int* count, const char* label, const char* value) {
+  if (value[0] == '\0' || *count >= MAX_EXTRA) return;
+  snprintf(extra[*count], MAX_LINE, "%-13.64s %.*s ", label, MAX_OUTPUT, value);
+  (*count)++;
+}
+
+void print_extra(char extra[][MAX_LINE], int count, size_t max_len, int indent) {
+  if (count == 0) return;
+
+  printf("%*s┌", indent, "");
+  for (size_t i = 0; i <= max_len; i++) printf("─");
+  printf("┐\n");
+
+  for (int i = 0; i < count; i++) {
+    printf("%*s│ %-*s│\n", indent, "", (int)max_len, extra[i]);
+  }
+
+  printf("%*s└", indent, "");
+  for (size_t i = 0; i <= max_len; i++) printf("─");
+  printf("┘\n");
+}
+
 const char** getart(char* distro) {
   static const char* default_art[]={
     GRAY"│──────────────"YELLOW""GRAY"───────────────────│"RESET,
@@ -597,10 +1593,43 @@ const char** getart(char* distro) {
 int main(int argc, char* argv[]) {
   setenv("NO_AT_BRIDGE", "1", 1);
 
+  if (argc > 2 && !strcmp(argv[1], "--history")) {
+    return snap_history(argv[2],
+                        argc > 3 ? strtoll(argv[3], NULL, 10) : INT64_MIN,
+                        argc > 4 ? strtoll(argv[4], NULL, 10) : INT64_MAX);
+  }
+
+  if (argc > 1 && !strcmp(argv[1], "--watch")) {
+    int interval = argc > 2 ? atoi(argv[2]) : 1;
+    char sensors[SENSOR_COUNT][MAX_OUTPUT];
+    if (interval < 1) interval = 1;
+
+    if (!sensors_open()) {
+      fprintf(stderr, "syfo: no sensors found\n");
+      return 1;
+    }
+
+    for (;;) {
+      const char* sep = "";
+      getsensors(sensors);
+      for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (sensors[i][0] == '\0') continue;
+        printf("%s%s: %s", sep, sensor_names[i], sensors[i]);
+        sep = "  ";
+      }
+      printf("\n");
+      fflush(stdout);
+      sleep(interval);
+    }
+  }
+
   char distro[MAX_OUTPUT], kernel[MAX_OUTPUT], uptime[MAX_OUTPUT];
   char pkgs[MAX_OUTPUT], wm[MAX_OUTPUT], term[MAX_OUTPUT];
   char shell[MAX_OUTPUT], cpu[MAX_OUTPUT], gpu[MAX_OUTPUT];
   char hostname[MAX_OUTPUT];
+  char sensors[SENSOR_COUNT][MAX_OUTPUT];
+  char disk_mounts[MAX_DISKS][MAX_OUTPUT], disk_usage[MAX_DISKS][MAX_OUTPUT];
+  char net[NET_COUNT][MAX_OUTPUT];
 
   // Get all information
   getdist(distro);
@@ -613,6 +1642,21 @@ int main(int argc, char* argv[]) {
   getcpu(cpu);
   getgpu(gpu);
   gethostname_wrapper(hostname);
+  getsensors(sensors);
+  int ndisks = getdisks(disk_mounts, disk_usage);
+  getnet(net);
+
+  if (argc > 2 && !strcmp(argv[1], "--record")) {
+    const char* fields[SNAP_FIELDS] = {
+      distro, kernel, uptime, pkgs, wm, term, shell, cpu, gpu, hostname,
+      sensors[SENSOR_CPU_TEMP], sensors[SENSOR_GPU_TEMP],
+      sensors[SENSOR_FAN], sensors[SENSOR_POWER],
+      disk_usage[0], disk_usage[1],
+      net[NET_IFACE], net[NET_IPV4], net[NET_IPV6],
+      sensors[SENSOR_GPU_FAN], sensors[SENSOR_GPU_POWER]
+    };
+    return snap_record(argv[2], fields);
+  }
 
   // Format output strings
   char line_distro[MAX_LINE], line_kernel[MAX_LINE], line_uptime[MAX_LINE];
@@ -629,6 +1673,24 @@ int main(int argc, char* argv[]) {
   snprintf(line_cpu, sizeof(line_cpu), "cpu:          %s ", cpu);
   snprintf(line_gpu, sizeof(line_gpu), "gpu:          %s ", gpu);
 
+  char extra[MAX_EXTRA][MAX_LINE];
+  int nextra = 0;
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    char label[32];
+    snprintf(label, sizeof(label), "%s:", sensor_names[i]);
+    add_extra(extra, &nextra, label, sensors[i]);
+  }
+  for (int i = 0; i < ndisks; i++) {
+    char label[MAX_OUTPUT + 8];
+    snprintf(label, sizeof(label), "disk %s:", disk_mounts[i]);
+    add_extra(extra, &nextra, label, disk_usage[i]);
+  }
+  for (int i = 0; i < NET_COUNT; i++) {
+    char label[32];
+    snprintf(label, sizeof(label), "%s:", net_names[i]);
+    add_extra(extra, &nextra, label, net[i]);
+  }
+
   // Find max length for proper box formatting
   size_t max_len = 0;
   size_t lens[] = {
@@ -640,6 +1702,9 @@ int main(int argc, char* argv[]) {
   for (int i = 0; i < 9; i++) {
     if (lens[i] > max_len) max_len = lens[i];
   }
+  for (int i = 0; i < nextra; i++) {
+    if (strlen(extra[i]) > max_len) max_len = strlen(extra[i]);
+  }
 
   // Print the output
   // Print each line with proper padding
@@ -673,6 +1738,7 @@ int main(int argc, char* argv[]) {
     printf("┘\n");
 
     printf("%s└─────────────────────────────────┘%s\n", GRAY, RESET);
+    print_extra(extra, nextra, max_len, 36);
   }
 
   else if (!strcmp(argv[1], "-v")) {
@@ -706,6 +1772,7 @@ int main(int argc, char* argv[]) {
     printf("└");
     for (size_t i = 0; i <= max_len; i++) printf("─");
     printf("┘\n");
+    print_extra(extra, nextra, max_len, 0);
   }
 
   else if (!strcmp(argv[1], "-q")) {
@@ -741,6 +1808,7 @@ int main(int argc, char* argv[]) {
     printf("└");
     for (size_t i = 0; i <= max_len; i++) printf("─");
     printf("┘\n");
+    print_extra(extra, nextra, max_len, 0);
   }
 
   return 0;